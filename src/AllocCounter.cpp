@@ -0,0 +1,197 @@
+#include "AllocCounter.h"
+
+#ifdef COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static std::atomic<size_t> allocCount{0};
+static std::atomic<size_t> allocBytes{0};
+
+static void* CountedAlloc(size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(size_t size)
+{
+    void* ptr = CountedAlloc(size);
+    if (ptr == nullptr)
+        throw std::bad_alloc{};
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+#ifdef __cpp_aligned_new
+
+// 超对齐类型的 new 不经过上面的重载，需要单独替换
+// MSVC 没有 aligned_alloc，且 _aligned_malloc 的内存必须用 _aligned_free 释放
+static void* CountedAlignedAlloc(size_t size, std::align_val_t align)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+
+    size_t alignment = static_cast<size_t>(align);
+    if (size == 0)
+        size = 1;
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) != 0)
+        return nullptr;
+    return ptr;
+#endif
+}
+
+static void AlignedFree(void* ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(size_t size, std::align_val_t align)
+{
+    void* ptr = CountedAlignedAlloc(size, align);
+    if (ptr == nullptr)
+        throw std::bad_alloc{};
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return CountedAlignedAlloc(size, align);
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return CountedAlignedAlloc(size, align);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    AlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    AlignedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+    AlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+    AlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    AlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    AlignedFree(ptr);
+}
+
+#endif // __cpp_aligned_new
+
+namespace AllocCounter
+{
+
+bool enabled()
+{
+    return true;
+}
+
+Stats snapshot()
+{
+    return Stats{
+        allocCount.load(std::memory_order_relaxed),
+        allocBytes.load(std::memory_order_relaxed),
+    };
+}
+
+} // namespace AllocCounter
+
+#else
+
+namespace AllocCounter
+{
+
+bool enabled()
+{
+    return false;
+}
+
+Stats snapshot()
+{
+    return Stats{0, 0};
+}
+
+} // namespace AllocCounter
+
+#endif // COUNT_ALLOCATIONS
@@ -0,0 +1,22 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// 堆分配统计，需要以 -DCOUNT_ALLOCATIONS=ON 构建
+// 开启后替换全局 operator new/delete，累计分配次数与字节数
+namespace AllocCounter
+{
+
+struct Stats
+{
+    size_t count;
+    size_t bytes;
+};
+
+bool enabled();
+Stats snapshot();
+
+} // namespace AllocCounter
+
+#endif // ALLOC_COUNTER_H
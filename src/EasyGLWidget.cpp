@@ -5,8 +5,9 @@
 #include <QOpenGLContext>
 #include <QDateTime>
 #include <QTimer>
+#include <QDebug>
 
-#include <vector>
+#include <cstdio>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -22,28 +23,43 @@ struct Light
     glm::vec3 pos;
 };
 
-struct Material
-{
-    float ambient[3];
-    float diffuse[3];
-    float specular[3];
-    float shininess;
-};
+#define STRINGIFY(x) #x
+#define TO_STRING(x) STRINGIFY(x)
 
+// 实例位置和材质索引是 per-instance 属性，model 矩阵在着色器中计算
 static const char *vertexShaderSource = 
     "#version 330 core\n"
     "layout (location = 0) in vec3 inPos;\n"
     "layout (location = 1) in vec3 inColor;\n"
+    "layout (location = 2) in float inInstanceX;\n"
+    "layout (location = 3) in float inInstanceY;\n"
+    "layout (location = 4) in float inInstanceZ;\n"
+    "layout (location = 5) in uint inMaterial;\n"
     "out vec3 vertexColor;\n"
     "out vec3 vertexPos;\n"
-    "uniform mat4 model;\n"
+    "flat out uint vertexMaterial;\n"
     "uniform mat4 view;\n"
     "uniform mat4 projection;\n"
+    "uniform float time;\n"
+    "uniform float firstInstance;\n"
+    "mat3 rotation(float angle, vec3 axis)\n"
+    "{\n"
+    "   vec3 a = normalize(axis);\n"
+    "   float c = cos(angle);\n"
+    "   float s = sin(angle);\n"
+    "   vec3 t = (1.0 - c) * a;\n"
+    "   return mat3(c + t.x * a.x, t.x * a.y + s * a.z, t.x * a.z - s * a.y,\n"
+    "               t.y * a.x - s * a.z, c + t.y * a.y, t.y * a.z + s * a.x,\n"
+    "               t.z * a.x + s * a.y, t.z * a.y - s * a.x, c + t.z * a.z);\n"
+    "}\n"
     "void main()\n"
     "{\n"
-    "   gl_Position = projection * view * model * vec4(inPos, 1.0);\n"
-    "   vertexPos = vec3(model * vec4(inPos, 1.0));\n"
+    "   float instance = firstInstance + float(gl_InstanceID);\n"
+    "   mat3 rotate = rotation(radians(20.0 * instance), vec3(1.0, 0.3, 0.5)) * rotation(time, vec3(0.5, 1.0, 0.0));\n"
+    "   vertexPos = rotate * inPos + vec3(inInstanceX, inInstanceY, inInstanceZ);\n"
+    "   gl_Position = projection * view * vec4(vertexPos, 1.0);\n"
     "   vertexColor = inColor;\n"
+    "   vertexMaterial = inMaterial;\n"
     "}\n";
 
 static const char *geometryShaderSource = 
@@ -52,9 +68,11 @@ static const char *geometryShaderSource =
     "layout (triangle_strip, max_vertices = 3) out;\n"
     "in vec3 vertexColor[];\n"
     "in vec3 vertexPos[];\n"
+    "flat in uint vertexMaterial[];\n"
     "out vec3 geometryColor;\n"
     "out vec3 geometryPos;\n"
     "out vec3 normalVec;\n"
+    "flat out uint geometryMaterial;\n"
     "void main()\n"
     "{\n"
     "   vec3 v1 = vertexPos[1] - vertexPos[0];\n"
@@ -65,6 +83,7 @@ static const char *geometryShaderSource =
     "       geometryColor = vertexColor[i];\n"
     "       geometryPos = vertexPos[i];\n"
     "       normalVec = norm;\n"
+    "       geometryMaterial = vertexMaterial[i];\n"
     "       EmitVertex();\n"
     "   }\n"
     "   EndPrimitive();"
@@ -75,6 +94,7 @@ static const char *fragmentShaderSource =
     "in vec3 geometryColor;\n"
     "in vec3 geometryPos;\n"
     "in vec3 normalVec;\n"
+    "flat in uint geometryMaterial;\n"
     "out vec4 fragmentColor;\n"
     "uniform vec3 cameraPos;\n"
     "struct Light{\n"
@@ -90,10 +110,11 @@ static const char *fragmentShaderSource =
     "   vec3 specular;\n"
     "   float shininess;\n"
     "};\n"
-    "uniform Material material;\n"
+    "uniform Material materials[" TO_STRING(SCENE_MAX_MATERIALS) "];\n"
     "uniform sampler2D inTexture;\n"
     "void main()\n"
     "{\n"
+    "   Material material = materials[geometryMaterial];\n"
     "   vec3 lightVec = normalize(light.pos - geometryPos);\n"
     "   vec3 diffuse = material.diffuse * max(dot(normalVec, lightVec), 0.0f);\n"
     "   vec3 cameraVec = normalize(cameraPos - geometryPos);\n"
@@ -127,34 +148,6 @@ static const char *lightfragmentShaderSource =
     "   fragmentColor = vec4(vertexColor, 1.0);\n"
     "}\n";
 
-// FROM: http://devernay.free.fr/cours/opengl/materials.html
-std::vector<Material> materials = {
-    {0.0215f, 0.1745f, 0.0215f, 0.07568f, 0.61424f, 0.07568f, 0.633f, 0.727811f, 0.633f, 0.6f},
-    {0.135f, 0.2225f, 0.1575f, 0.54f, 0.89f, 0.63f, 0.316228f, 0.316228f, 0.316228f, 0.1f},
-    {0.05375f, 0.05f, 0.06625f, 0.18275f, 0.17f, 0.22525f, 0.332741f, 0.328634f, 0.346435f, 0.3f},
-    {0.25f, 0.20725f, 0.20725f, 1.0f, 0.829f, 0.829f, 0.296648f, 0.296648f, 0.296648f, 0.088f},
-    {0.1745f, 0.01175f, 0.01175f, 0.61424f, 0.04136f, 0.04136f, 0.727811f, 0.626959f, 0.626959f, 0.6f},
-    {0.1f, 0.18725f, 0.1745f, 0.396f, 0.74151f, 0.69102f, 0.297254f, 0.30829f, 0.306678f, 0.1f},
-    {0.329412f, 0.223529f, 0.027451f, 0.780392f, 0.568627f, 0.113725f, 0.992157f, 0.941176f, 0.807843f, 0.21794872f},
-    {0.2125f, 0.1275f, 0.054f, 0.714f, 0.4284f, 0.18144f, 0.393548f, 0.271906f, 0.166721f, 0.2f},
-    {0.25f, 0.25f, 0.25f, 0.4f, 0.4f, 0.4f, 0.774597f, 0.774597f, 0.774597f, 0.6f},
-    {0.19125f, 0.0735f, 0.0225f, 0.7038f, 0.27048f, 0.0828f, 0.256777f, 0.137622f, 0.086014f, 0.1f},
-    {0.24725f, 0.1995f, 0.0745f, 0.75164f, 0.60648f, 0.22648f, 0.628281f, 0.555802f, 0.366065f, 0.4f},
-    {0.19225f, 0.19225f, 0.19225f, 0.50754f, 0.50754f, 0.50754f, 0.508273f, 0.508273f, 0.508273f, 0.4f},
-    {0.0f, 0.0f, 0.0f, 0.01f, 0.01f, 0.01f, 0.50f, 0.50f, 0.50f, 0.25f},
-    {0.0f, 0.1f, 0.06f, 0.0f, 0.50980392f, 0.50980392f, 0.50196078f, 0.50196078f, 0.50196078f, 0.25f},
-    {0.0f, 0.0f, 0.0f, 0.1f, 0.35f, 0.1f, 0.45f, 0.55f, 0.45f, 0.25f},
-    {0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 0.7f, 0.6f, 0.6f, 0.25f},
-    {0.0f, 0.0f, 0.0f, 0.55f, 0.55f, 0.55f, 0.70f, 0.70f, 0.70f, 0.25f},
-    {0.0f, 0.0f, 0.0f, 0.5f, 0.5f, 0.0f, 0.60f, 0.60f, 0.50f, 0.25f},
-    {0.02f, 0.02f, 0.02f, 0.01f, 0.01f, 0.01f, 0.4f, 0.4f, 0.4f, 0.078125f},
-    {0.0f, 0.05f, 0.05f, 0.4f, 0.5f, 0.5f, 0.04f, 0.7f, 0.7f, 0.078125f},
-    {0.0f, 0.05f, 0.0f, 0.4f, 0.5f, 0.4f, 0.04f, 0.7f, 0.04f, 0.078125f},
-    {0.05f, 0.0f, 0.0f, 0.5f, 0.4f, 0.4f, 0.7f, 0.04f, 0.04f, 0.078125f},
-    {0.05f, 0.05f, 0.05f, 0.5f, 0.5f, 0.5f, 0.7f, 0.7f, 0.7f, 0.078125f},
-    {0.05f, 0.05f, 0.0f, 0.5f, 0.5f, 0.4f, 0.7f, 0.7f, 0.04f, 0.078125f},
-};
-
 static GLADapiproc GetProcAddress(const char *name)
 {
     QOpenGLContext* ctx = QOpenGLContext::currentContext();
@@ -166,8 +159,53 @@ static float GetTime()
     return static_cast<float>(QDateTime::currentMSecsSinceEpoch() % 1000000 / 1000.0);
 }
 
+// GL 对象需要在 context 创建后构造，在 initializeGL 中创建，paintGL 中只设置 uniform 和绘制
+struct EasyGLWidget::GLObjects
+{
+    Light light;
+
+    ShaderProgram lightShaderProgram;
+    VertexBuffer lightVertexBuffer;
+    VertexArray lightVertexArray;
+
+    ShaderProgram shaderProgram;
+    VertexBuffer vertexBuffer;
+    VertexArray vertexArray;
+    IndexBuffer indexBuffer;
+
+    // per-instance 属性，依次为 posX、posY、posZ、materialIndex
+    // EasyGL 没有封装 glVertexAttribDivisor，直接使用 GL 接口
+    GLuint instanceBuffers[4];
+
+    // 摄像机
+    Camera camera{glm::vec3{0.0f, 0.0f, 10.0f}};
+
+    GLObjects()
+    {
+        glGenBuffers(4, instanceBuffers);
+    }
+
+    ~GLObjects()
+    {
+        glDeleteBuffers(4, instanceBuffers);
+    }
+};
+
+// 每帧绘制列表中的一项，对应一个网格的实例化绘制
+struct DrawCommand
+{
+    GLsizei indexCount;
+    void* indexOffset;
+    void* instanceOffset;
+    uint32_t firstInstance;
+    GLsizei instanceCount;
+};
+
 EasyGLWidget::EasyGLWidget(QWidget* parent):
-    QOpenGLWidget{parent}
+    QOpenGLWidget{parent},
+    m_arena{4 * 1024},
+    m_allocTotal{0, 0},
+    m_allocFrames{0}
 {
     QTimer* timer = new QTimer{this};
     connect(timer, &QTimer::timeout, [this](){
@@ -178,28 +216,44 @@ EasyGLWidget::EasyGLWidget(QWidget* parent):
 
 EasyGLWidget::~EasyGLWidget()
 {
-    
+    // 释放 GL 对象时 context 必须是当前的
+    if (m_gl)
+    {
+        makeCurrent();
+        m_gl.reset();
+        doneCurrent();
+    }
 }
 
-void EasyGLWidget::initializeGL()
+bool EasyGLWidget::loadScene(const QString& path)
 {
-    gladLoadGL(GetProcAddress);
+    if (!m_scene.load(path))
+        return false;
+
+    if (m_gl)
+    {
+        makeCurrent();
+        uploadScene();
+        doneCurrent();
+    }
+    updateGeometry();
+    return true;
 }
 
-void EasyGLWidget::paintGL()
+void EasyGLWidget::initializeGL()
 {
-    glEnable(GL_DEPTH_TEST);
+    gladLoadGL(GetProcAddress);
+    m_gl.reset(new GLObjects);
+
     // 光源
     VertexShader lightVertexShader{lightVertexShaderSource};
     FragmentShader lightFragmentShader{lightfragmentShaderSource};
-    ShaderProgram lightShaderProgram;
-    lightShaderProgram.attach(lightVertexShader);
-    lightShaderProgram.attach(lightFragmentShader);
-    lightShaderProgram.link();
-    lightShaderProgram.use();
+    m_gl->lightShaderProgram.attach(lightVertexShader);
+    m_gl->lightShaderProgram.attach(lightFragmentShader);
+    m_gl->lightShaderProgram.link();
 
     glm::vec3 lightColor{1.0f, 1.0f, 1.0f};
-    Light light{
+    m_gl->light = Light{
         0.2f*lightColor,
         0.5f*lightColor,
         1.0f*lightColor,
@@ -216,91 +270,105 @@ void EasyGLWidget::paintGL()
          0.0f,  0.0f,  0.1f,    lightColor[0], lightColor[1], lightColor[2],
     };
 
-    VertexBuffer lightVertexBuffer;
-    lightVertexBuffer.setData(sizeof(lightVertices), lightVertices, VertexBuffer::Usage::StreamDraw);
-
-    VertexArray lightVertexArray;
-    lightVertexArray.attribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(float), (void*)0);
-    lightVertexArray.attribPointer(1, 3, GL_FLOAT, false, 6 * sizeof(float), (void*)(sizeof(float) * 3));
+    m_gl->lightVertexBuffer.setData(sizeof(lightVertices), lightVertices, VertexBuffer::Usage::StaticDraw);
+    m_gl->lightVertexArray.bind();
+    m_gl->lightVertexArray.attribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(float), (void*)0);
+    m_gl->lightVertexArray.attribPointer(1, 3, GL_FLOAT, false, 6 * sizeof(float), (void*)(sizeof(float) * 3));
 
     // 图形
     VertexShader vertexShader{vertexShaderSource};
     GeometryShader geometryShader{geometryShaderSource};
     FragmentShader fragmentShader{fragmentShaderSource};
-    ShaderProgram shaderProgram;
-    shaderProgram.attach(vertexShader);
-    shaderProgram.attach(geometryShader);
-    shaderProgram.attach(fragmentShader);
-    shaderProgram.link();
-    shaderProgram.use();
-
-    //   4 --- 5
-    //  /|    /|
-    // 0 --- 1 |  
-    // | 7 --| 6
-    // |/    |/
-    // 3 --- 2
-
-    float vertices[] = {
-        // ---- 位置 ----      - 颜色 -
-        -0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 1.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  1.0f, 1.0f, 1.0f,
-        
-        -0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 1.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  1.0f, 1.0f, 1.0f,
-    };
-
-    unsigned int indices[] = {  
-        0, 1, 2, // first triangle
-        0, 2, 3,  // second triangle
+    m_gl->shaderProgram.attach(vertexShader);
+    m_gl->shaderProgram.attach(geometryShader);
+    m_gl->shaderProgram.attach(fragmentShader);
+    m_gl->shaderProgram.link();
+
+    // 光照参数不随帧变化，只设置一次
+    m_gl->shaderProgram.use();
+    m_gl->shaderProgram.setVector<3>("light.ambient", glm::value_ptr(m_gl->light.ambient));     // 设置环境光
+    m_gl->shaderProgram.setVector<3>("light.diffuse", glm::value_ptr(m_gl->light.diffuse));     // 设置漫反射光
+    m_gl->shaderProgram.setVector<3>("light.specular", glm::value_ptr(m_gl->light.specular));   // 设置镜面反射光
+
+    if (m_scene.isLoaded())
+        uploadScene();
+}
 
-        5, 4, 7,
-        5, 7, 6,
+// 顶点、索引和实例数组直接从映射的场景文件上传，只在加载场景后执行一次
+void EasyGLWidget::uploadScene()
+{
+    m_gl->vertexBuffer.setData(m_scene.vertexCount() * SceneVertexStride * sizeof(float), m_scene.vertices(), VertexBuffer::Usage::StaticDraw);
+    m_gl->vertexArray.bind();
+    m_gl->vertexArray.attribPointer(0, 3, GL_FLOAT, false, SceneVertexStride * sizeof(float), (void*)0);
+    m_gl->vertexArray.attribPointer(1, 3, GL_FLOAT, false, SceneVertexStride * sizeof(float), (void*)(sizeof(float) * 3));
+    m_gl->indexBuffer.setData(m_scene.indexCount() * sizeof(uint32_t), m_scene.indices(), IndexBuffer::Usage::StaticDraw);
+
+    const void* instanceData[4] = {m_scene.posX(), m_scene.posY(), m_scene.posZ(), m_scene.materialIndex()};
+    for (GLuint i = 0; i < 4; i++)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_gl->instanceBuffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, m_scene.instanceCount() * sizeof(uint32_t), instanceData[i], GL_STATIC_DRAW);
+        glEnableVertexAttribArray(2 + i);
+        glVertexAttribDivisor(2 + i, 1);
+    }
 
-        1, 5, 6,
-        1, 6, 2,
+    // 材质表
+    m_gl->shaderProgram.use();
+    char name[64];
+    for (uint32_t i = 0; i < m_scene.materialCount(); i++)
+    {
+        const Material& material = m_scene.materials()[i];
+        std::snprintf(name, sizeof(name), "materials[%u].ambient", i);
+        m_gl->shaderProgram.setVector<3>(name, material.ambient);           // 设置环境光系数
+        std::snprintf(name, sizeof(name), "materials[%u].diffuse", i);
+        m_gl->shaderProgram.setVector<3>(name, material.diffuse);           // 设置漫反射系数
+        std::snprintf(name, sizeof(name), "materials[%u].specular", i);
+        m_gl->shaderProgram.setVector<3>(name, material.specular);          // 设置镜面反射系数
+        std::snprintf(name, sizeof(name), "materials[%u].shininess", i);
+        m_gl->shaderProgram.setValue(name, material.shininess * 128);       // 设置反光度
+    }
+}
 
-        4, 0, 3,
-        4, 3, 7,
-    
-        4, 5, 1,
-        4, 1, 0,
+void EasyGLWidget::paintGL()
+{
+    AllocCounter::Stats allocBegin = AllocCounter::snapshot();
 
-        3, 2, 6,
-        3, 6, 7,
-    };
+    drawScene();
+    m_arena.reset();
 
-    VertexBuffer vertexBuffer;
-    vertexBuffer.setData(sizeof(vertices), vertices, VertexBuffer::Usage::StreamDraw);
+    // 堆分配统计，所有绘制路径都经过这里；输出日志本身的分配不计入帧内
+    if (AllocCounter::enabled())
+    {
+        AllocCounter::Stats allocEnd = AllocCounter::snapshot();
+        m_allocTotal.count += allocEnd.count - allocBegin.count;
+        m_allocTotal.bytes += allocEnd.bytes - allocBegin.bytes;
+        m_allocFrames += 1;
+        if (m_allocFrames == 50)
+        {
+            qDebug("EasyGLWidget: %.1f allocs, %.1f bytes per frame",
+                   static_cast<double>(m_allocTotal.count) / m_allocFrames,
+                   static_cast<double>(m_allocTotal.bytes) / m_allocFrames);
+            m_allocTotal = AllocCounter::Stats{0, 0};
+            m_allocFrames = 0;
+        }
+    }
+}
 
-    VertexArray vertexArray;
-    vertexArray.attribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(float), (void*)0);
-    vertexArray.attribPointer(1, 3, GL_FLOAT, false, 6 * sizeof(float), (void*)(sizeof(float) * 3));
+void EasyGLWidget::drawScene()
+{
+    glEnable(GL_DEPTH_TEST);
+    if (!m_scene.isLoaded())
+    {
+        glClearColor(0.2f, 0.2f, 0.2f, 0.1f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        return;
+    }
 
-    IndexBuffer indexBuffer;
-    indexBuffer.setData(sizeof(indices), indices, IndexBuffer::Usage::StaticDraw);
-
-    // 世界坐标
-    std::vector<glm::vec3> cubePositions = {
-        glm::vec3( 0.0f,  0.0f,  0.0f),
-        glm::vec3( 2.0f,  5.0f, -15.0f),
-        glm::vec3(-1.5f, -2.2f, -2.5f),
-        glm::vec3(-3.8f, -2.0f, -12.3f),
-        glm::vec3( 2.4f, -0.4f, -3.5f),
-        glm::vec3(-1.7f,  3.0f, -7.5f),
-        glm::vec3( 1.3f, -2.0f, -2.5f),
-        glm::vec3( 1.5f,  2.0f, -2.5f),
-        glm::vec3( 1.5f,  0.2f, -1.5f),
-        glm::vec3(-1.3f,  1.0f, -1.5f),
-    };
+    Light& light = m_gl->light;
+    Camera& camera = m_gl->camera;
+    ShaderProgram& lightShaderProgram = m_gl->lightShaderProgram;
+    ShaderProgram& shaderProgram = m_gl->shaderProgram;
 
-    // 摄像机
-    Camera camera{glm::vec3{0.0f, 0.0f, 10.0f}};
-    
     // 绘图
     float aspect = static_cast<float>(width()) / static_cast<float>(height());
     glm::mat4 projection = camera.projection(aspect);
@@ -310,7 +378,7 @@ void EasyGLWidget::paintGL()
 
     // 绘制光源
     lightShaderProgram.use();
-    lightVertexArray.bind();
+    m_gl->lightVertexArray.bind();
     lightShaderProgram.setMatrix<4>("view", glm::value_ptr(camera.view())); // 摄像机 View
     lightShaderProgram.setMatrix<4>("projection", glm::value_ptr(projection));  // 摄像机投影
     float radius = 3.0f;
@@ -327,27 +395,44 @@ void EasyGLWidget::paintGL()
 
     // 绘制图形
     shaderProgram.use();
-    vertexArray.bind();
+    m_gl->vertexArray.bind();
     shaderProgram.setMatrix<4>("view", glm::value_ptr(camera.view()));      // 摄像机 View
     shaderProgram.setMatrix<4>("projection", glm::value_ptr(projection));   // 摄像机投影
     shaderProgram.setVector<3>("cameraPos", glm::value_ptr(camera.pos()));  // 设置 view 坐标计算镜面光照
     shaderProgram.setVector<3>("light.pos", glm::value_ptr(light.pos));
-    shaderProgram.setVector<3>("light.ambient", glm::value_ptr(light.ambient));             // 设置环境光
-    shaderProgram.setVector<3>("light.diffuse", glm::value_ptr(light.diffuse));             // 设置漫反射光
-    shaderProgram.setVector<3>("light.specular", glm::value_ptr(light.specular));           // 设置镜面反射光
-    for (size_t i = 0; i < cubePositions.size(); i++)
+    shaderProgram.setValue("time", GetTime());                              // 动画
+
+    // 绘制列表放在每帧的 arena 中，跳过没有实例的网格
+    const SceneMesh* meshes = m_scene.meshes();
+    DrawCommand* commands = m_arena.alloc<DrawCommand>(m_scene.meshCount());
+    uint32_t commandCount = 0;
+    for (uint32_t i = 0; i < m_scene.meshCount(); i++)
+    {
+        if (meshes[i].instanceCount == 0)
+            continue;
+        DrawCommand& command = commands[commandCount++];
+        command.indexCount = meshes[i].indexCount;
+        command.indexOffset = (void*)(sizeof(uint32_t) * meshes[i].firstIndex);
+        command.instanceOffset = (void*)(sizeof(uint32_t) * meshes[i].firstInstance);
+        command.firstInstance = meshes[i].firstInstance;
+        command.instanceCount = meshes[i].instanceCount;
+    }
+
+    // 每个网格一次实例化绘制；GL 3.3 没有 baseInstance，通过属性偏移选择该网格的实例
+    for (uint32_t i = 0; i < commandCount; i++)
     {
-        size_t index = i % materials.size();
-        shaderProgram.setVector<3>("material.ambient", materials[index].ambient);       // 设置环境光系数
-        shaderProgram.setVector<3>("material.diffuse", materials[index].diffuse);       // 设置漫反射系数
-        shaderProgram.setVector<3>("material.specular", materials[index].specular);     // 设置镜面反射系数
-        shaderProgram.setValue("material.shininess", materials[index].shininess * 128); // 设置反光度
-        glm::mat4 model{1.0f};
-        model = glm::translate(model, cubePositions[i]); // 移动到世界坐标
-        model = glm::rotate(model, glm::radians(20.0f * i), glm::vec3(1.0f, 0.3f, 0.5f)); // 随便加点角度
-        model = glm::rotate(model, GetTime(), glm::vec3(0.5f, 1.0f, 0.0f)); // 动画
-        shaderProgram.setMatrix<4>("model", glm::value_ptr(model));
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        const DrawCommand& command = commands[i];
+        for (GLuint k = 0; k < 3; k++)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, m_gl->instanceBuffers[k]);
+            glVertexAttribPointer(2 + k, 1, GL_FLOAT, GL_FALSE, 0, command.instanceOffset);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, m_gl->instanceBuffers[3]);
+        glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, 0, command.instanceOffset);
+
+        shaderProgram.setValue("firstInstance", static_cast<float>(command.firstInstance));
+        glDrawElementsInstanced(GL_TRIANGLES, command.indexCount, GL_UNSIGNED_INT,
+                                command.indexOffset, command.instanceCount);
     }
 }
 
@@ -358,5 +443,7 @@ void EasyGLWidget::resizeGL(int w, int h)
 
 QSize EasyGLWidget::sizeHint() const
 {
-    return QSize{640, 640};
+    if (!m_scene.isLoaded())
+        return QSize{640, 640};
+    return m_scene.size();
 }
\ No newline at end of file
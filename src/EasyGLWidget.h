@@ -3,6 +3,12 @@
 
 #include <QOpenGLWidget>
 
+#include <memory>
+
+#include "FrameArena.h"
+#include "AllocCounter.h"
+#include "Scene.h"
+
 class EasyGLWidget : public QOpenGLWidget
 {
     Q_OBJECT
@@ -10,12 +16,26 @@ public:
     EasyGLWidget(QWidget* parent=nullptr);
     ~EasyGLWidget();
 
+    bool loadScene(const QString& path);
+
 protected:
     virtual void initializeGL() override;
     virtual void paintGL() override;
     virtual void resizeGL(int w, int h) override;
 
     virtual QSize sizeHint() const override;
+
+private:
+    struct GLObjects;
+
+    void uploadScene();
+    void drawScene();
+
+    std::unique_ptr<GLObjects> m_gl;    // 在 initializeGL 中创建的 GL 对象
+    Scene m_scene;                      // 内存映射的场景文件
+    FrameArena m_arena;                 // 每帧临时数据（绘制列表等），paintGL 结束时 reset
+    AllocCounter::Stats m_allocTotal;   // 统计周期内累计的堆分配
+    int m_allocFrames;                  // 统计周期内的帧数
 };
 
 #endif // EASYGL_WIDGET_H
\ No newline at end of file
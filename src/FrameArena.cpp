@@ -0,0 +1,58 @@
+#include "FrameArena.h"
+
+#include <cstdint>
+
+FrameArena::FrameArena(size_t capacity):
+    m_buffer{new unsigned char[capacity]},
+    m_capacity{capacity},
+    m_offset{0},
+    m_overflowBytes{0}
+{
+
+}
+
+FrameArena::~FrameArena()
+{
+
+}
+
+void* FrameArena::allocate(size_t size, size_t align)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_buffer.get());
+    uintptr_t aligned = (base + m_offset + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+    size_t offset = static_cast<size_t>(aligned - base);
+    if (offset + size <= m_capacity)
+    {
+        m_offset = offset + size;
+        return m_buffer.get() + offset;
+    }
+
+    // 容量不足，本帧从堆上临时分配，下次 reset 时扩容
+    // new[] 只保证 max_align_t 对齐，多申请 align 字节用于手动对齐
+    m_overflowBytes += size + align;
+    m_overflow.emplace_back(new unsigned char[size + align]);
+    uintptr_t block = reinterpret_cast<uintptr_t>(m_overflow.back().get());
+    return reinterpret_cast<void*>((block + align - 1) & ~(static_cast<uintptr_t>(align) - 1));
+}
+
+void FrameArena::reset()
+{
+    if (!m_overflow.empty())
+    {
+        m_capacity = m_capacity + m_overflowBytes;
+        m_buffer.reset(new unsigned char[m_capacity]);
+        m_overflow.clear();
+        m_overflowBytes = 0;
+    }
+    m_offset = 0;
+}
+
+size_t FrameArena::used() const
+{
+    return m_offset + m_overflowBytes;
+}
+
+size_t FrameArena::capacity() const
+{
+    return m_capacity;
+}
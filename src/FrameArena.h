@@ -0,0 +1,42 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// 每帧的线性分配器，用于矩阵、绘制列表、上传暂存等临时数据
+// 帧结束时调用 reset 整体释放；容量不足时临时从堆上分配，并在 reset 时扩容，
+// 因此稳定状态下每帧不产生任何堆分配
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t capacity);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t align=alignof(std::max_align_t));
+    void reset();
+
+    size_t used() const;
+    size_t capacity() const;
+
+    // 分配 count 个未初始化的 T，T 必须是平凡析构的
+    template<typename T>
+    T* alloc(size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+private:
+    std::unique_ptr<unsigned char[]> m_buffer;
+    size_t m_capacity;
+    size_t m_offset;
+    size_t m_overflowBytes;
+    std::vector<std::unique_ptr<unsigned char[]>> m_overflow;
+};
+
+#endif // FRAME_ARENA_H
@@ -1,5 +1,9 @@
 #include "MainWindow.h"
 
+#include <QCoreApplication>
+#include <QMessageBox>
+#include <QStringList>
+
 MainWindow::MainWindow(QWidget* parent):
     QDialog{parent},
     m_layout{new QGridLayout},
@@ -7,6 +11,15 @@ MainWindow::MainWindow(QWidget* parent):
     m_glad{new GLADWidget},
     m_glew{new GLEWWidget}
 {
+    // 场景文件由第一个命令行参数指定，默认为程序目录下的 default.scene
+    QStringList args = QCoreApplication::arguments();
+    QString scenePath = args.size() > 1 ? args[1] : QCoreApplication::applicationDirPath() + "/default.scene";
+    if (!m_easy->loadScene(scenePath))
+    {
+        QMessageBox::warning(this, tr("Scene"),
+                             tr("Failed to load scene file:\n%1\n\nThe EasyGL panel will stay empty.").arg(scenePath));
+    }
+
     m_layout->addWidget(m_easy, 0, 0, 2, 1);
     m_layout->addWidget(m_glad, 0, 1);
     m_layout->addWidget(m_glew, 1, 1);
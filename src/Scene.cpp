@@ -0,0 +1,542 @@
+#include "Scene.h"
+
+#include <QDebug>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char SceneMagic[4] = {'Q', 'N', 'G', 'S'};
+
+static uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + 15) & ~static_cast<uint64_t>(15);
+}
+
+// 检查 [offset, offset + count * elementSize) 是否在文件范围内，并且满足对齐
+static bool CheckSection(uint64_t fileSize, uint64_t offset, uint64_t count, uint64_t elementSize)
+{
+    if (offset % 4 != 0 || offset > fileSize)
+        return false;
+    return count <= (fileSize - offset) / elementSize;
+}
+
+static bool WritePadding(QFile& file, uint64_t offset)
+{
+    static const char zeros[16] = {0};
+    uint64_t padding = AlignOffset(offset) - offset;
+    return file.write(zeros, static_cast<qint64>(padding)) == static_cast<qint64>(padding);
+}
+
+template<typename T>
+static bool WriteSection(QFile& file, const std::vector<T>& section)
+{
+    qint64 size = static_cast<qint64>(section.size() * sizeof(T));
+    if (size == 0)
+        return true;
+    return file.write(reinterpret_cast<const char*>(section.data()), size) == size;
+}
+
+// 解析一个 uint32，拒绝负数和超出范围的值，成功时 text 移动到数字之后
+static bool ParseUInt(const char*& text, uint32_t& value)
+{
+    const char* start = text;
+    while (*start == ' ' || *start == '\t')
+        start++;
+    if (*start < '0' || *start > '9')
+        return false;
+
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long number = std::strtoull(start, &end, 10);
+    if (errno == ERANGE || number > UINT32_MAX)
+        return false;
+
+    value = static_cast<uint32_t>(number);
+    text = end;
+    return true;
+}
+
+// 解析一个 float，拒绝超出范围的值，成功时 text 移动到数字之后
+static bool ParseFloat(const char*& text, float& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    float number = std::strtof(text, &end);
+    if (end == text || errno == ERANGE)
+        return false;
+
+    value = number;
+    text = end;
+    return true;
+}
+
+static bool ParseFloats(const char*& text, float* values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (!ParseFloat(text, values[i]))
+            return false;
+    }
+    return true;
+}
+
+// 解析出的字段之后只允许空白或注释
+static bool AtLineEnd(const char* text)
+{
+    while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n')
+        text++;
+    return *text == '\0' || *text == '#';
+}
+
+// 写出和加载共用的检查：网格范围、顶点索引、材质索引都不能越界
+static bool CheckScene(uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                       const SceneMesh* meshes, uint32_t meshCount, uint32_t materialCount,
+                       const uint32_t* materialIndex, uint32_t instanceCount)
+{
+    if (meshCount == 0)
+    {
+        qWarning("Scene: no mesh");
+        return false;
+    }
+
+    if (materialCount == 0 || materialCount > SceneMaxMaterials)
+    {
+        qWarning("Scene: %u materials, expected 1 to %u", materialCount, SceneMaxMaterials);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < meshCount; i++)
+    {
+        if (meshes[i].firstIndex > indexCount || meshes[i].indexCount > indexCount - meshes[i].firstIndex)
+        {
+            qWarning("Scene: mesh %u references indices [%u, %u + %u), but there are only %u indices",
+                     i, meshes[i].firstIndex, meshes[i].firstIndex, meshes[i].indexCount, indexCount);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < indexCount; i++)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            qWarning("Scene: index %u references vertex %u, but there are only %u vertices",
+                     i, indices[i], vertexCount);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        if (materialIndex[i] >= materialCount)
+        {
+            qWarning("Scene: instance %u references material %u, but there are only %u materials",
+                     i, materialIndex[i], materialCount);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ParseSceneText(const QString& path, SceneData& data)
+{
+    QFile file{path};
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qWarning("Scene: cannot open %s", qPrintable(path));
+        return false;
+    }
+
+    int lineNumber = 0;
+    while (!file.atEnd())
+    {
+        QByteArray line = file.readLine();
+        lineNumber++;
+
+        const char* text = line.constData();
+        while (*text == ' ' || *text == '\t')
+            text++;
+        if (*text == '\0' || *text == '\n' || *text == '\r' || *text == '#')
+            continue;
+
+        bool ok = false;
+        if (std::strncmp(text, "size ", 5) == 0)
+        {
+            text += 5;
+            ok = ParseUInt(text, data.width) && ParseUInt(text, data.height) && AtLineEnd(text);
+        }
+        else if (std::strncmp(text, "vertex ", 7) == 0)
+        {
+            float v[SceneVertexStride];
+            text += 7;
+            ok = ParseFloats(text, v, SceneVertexStride) && AtLineEnd(text);
+            if (ok)
+                data.vertices.insert(data.vertices.end(), v, v + SceneVertexStride);
+        }
+        else if (std::strncmp(text, "index ", 6) == 0)
+        {
+            text += 6;
+            uint32_t index;
+            do
+            {
+                ok = ParseUInt(text, index);
+                if (ok)
+                    data.indices.push_back(index);
+            } while (ok && !AtLineEnd(text));
+        }
+        else if (std::strncmp(text, "mesh ", 5) == 0)
+        {
+            SceneMesh mesh = {0, 0, 0, 0};
+            text += 5;
+            ok = ParseUInt(text, mesh.firstIndex) && ParseUInt(text, mesh.indexCount) && AtLineEnd(text);
+            if (ok)
+                data.meshes.push_back(mesh);
+        }
+        else if (std::strncmp(text, "material ", 9) == 0)
+        {
+            Material m;
+            text += 9;
+            ok = ParseFloats(text, m.ambient, 3) && ParseFloats(text, m.diffuse, 3) &&
+                 ParseFloats(text, m.specular, 3) && ParseFloat(text, m.shininess) && AtLineEnd(text);
+            if (ok)
+                data.materials.push_back(m);
+        }
+        else if (std::strncmp(text, "instance ", 9) == 0)
+        {
+            float pos[3];
+            uint32_t material, mesh;
+            text += 9;
+            ok = ParseFloats(text, pos, 3) && ParseUInt(text, material) && ParseUInt(text, mesh) && AtLineEnd(text);
+            if (ok)
+            {
+                data.posX.push_back(pos[0]);
+                data.posY.push_back(pos[1]);
+                data.posZ.push_back(pos[2]);
+                data.materialIndex.push_back(material);
+                data.meshIndex.push_back(mesh);
+            }
+        }
+
+        if (!ok)
+        {
+            qWarning("Scene: %s:%d: invalid line", qPrintable(path), lineNumber);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool WriteScene(const QString& path, const SceneData& data)
+{
+    size_t instanceCount = data.posX.size();
+    if (data.vertices.size() % SceneVertexStride != 0 ||
+        data.posY.size() != instanceCount ||
+        data.posZ.size() != instanceCount ||
+        data.materialIndex.size() != instanceCount ||
+        data.meshIndex.size() != instanceCount)
+    {
+        qWarning("Scene: inconsistent scene data");
+        return false;
+    }
+
+    // header 中的数量都是 uint32，超出时拒绝写出，避免截断后 header 与数据不一致
+    if (data.vertices.size() / SceneVertexStride > UINT32_MAX ||
+        data.indices.size() > UINT32_MAX ||
+        data.meshes.size() > UINT32_MAX ||
+        data.materials.size() > UINT32_MAX ||
+        instanceCount > UINT32_MAX)
+    {
+        qWarning("Scene: too large, every count must fit in 32 bits "
+                 "(%zu vertices, %zu indices, %zu meshes, %zu materials, %zu instances)",
+                 data.vertices.size() / SceneVertexStride, data.indices.size(),
+                 data.meshes.size(), data.materials.size(), instanceCount);
+        return false;
+    }
+
+    SceneHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SceneMagic, sizeof(header.magic));
+    header.version = SceneVersion;
+    header.width = data.width;
+    header.height = data.height;
+    header.vertexCount = static_cast<uint32_t>(data.vertices.size() / SceneVertexStride);
+    header.indexCount = static_cast<uint32_t>(data.indices.size());
+    header.meshCount = static_cast<uint32_t>(data.meshes.size());
+    header.materialCount = static_cast<uint32_t>(data.materials.size());
+    header.instanceCount = static_cast<uint32_t>(instanceCount);
+
+    uint64_t offset = AlignOffset(sizeof(SceneHeader));
+    header.verticesOffset = offset;
+    offset = AlignOffset(offset + data.vertices.size() * sizeof(float));
+    header.indicesOffset = offset;
+    offset = AlignOffset(offset + data.indices.size() * sizeof(uint32_t));
+    header.meshesOffset = offset;
+    offset = AlignOffset(offset + data.meshes.size() * sizeof(SceneMesh));
+    header.materialsOffset = offset;
+    offset = AlignOffset(offset + data.materials.size() * sizeof(Material));
+    header.posXOffset = offset;
+    offset = AlignOffset(offset + instanceCount * sizeof(float));
+    header.posYOffset = offset;
+    offset = AlignOffset(offset + instanceCount * sizeof(float));
+    header.posZOffset = offset;
+    offset = AlignOffset(offset + instanceCount * sizeof(float));
+    header.materialIndexOffset = offset;
+
+    if (!CheckScene(static_cast<uint32_t>(data.vertices.size() / SceneVertexStride),
+                    data.indices.data(), static_cast<uint32_t>(data.indices.size()),
+                    data.meshes.data(), static_cast<uint32_t>(data.meshes.size()),
+                    static_cast<uint32_t>(data.materials.size()),
+                    data.materialIndex.data(), static_cast<uint32_t>(instanceCount)))
+        return false;
+
+    for (size_t i = 0; i < instanceCount; i++)
+    {
+        if (data.meshIndex[i] >= data.meshes.size())
+        {
+            qWarning("Scene: instance %zu references mesh %u, but there are only %zu meshes",
+                     i, data.meshIndex[i], data.meshes.size());
+            return false;
+        }
+    }
+
+    // 按网格分组（计数排序，保持原有顺序），并计算每个网格的实例范围
+    std::vector<SceneMesh> meshes = data.meshes;
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        meshes[i].firstInstance = 0;
+        meshes[i].instanceCount = 0;
+    }
+    for (size_t i = 0; i < instanceCount; i++)
+        meshes[data.meshIndex[i]].instanceCount++;
+    // instanceCount 已经检查过不超过 UINT32_MAX，各网格的实例范围之和不会溢出
+    uint32_t firstInstance = 0;
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        meshes[i].firstInstance = firstInstance;
+        firstInstance += meshes[i].instanceCount;
+    }
+
+    std::vector<uint32_t> order(instanceCount);
+    std::vector<uint32_t> cursor(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++)
+        cursor[i] = meshes[i].firstInstance;
+    for (size_t i = 0; i < instanceCount; i++)
+        order[cursor[data.meshIndex[i]]++] = static_cast<uint32_t>(i);
+
+    std::vector<float> posX(instanceCount);
+    std::vector<float> posY(instanceCount);
+    std::vector<float> posZ(instanceCount);
+    std::vector<uint32_t> materialIndex(instanceCount);
+    for (size_t i = 0; i < instanceCount; i++)
+    {
+        posX[i] = data.posX[order[i]];
+        posY[i] = data.posY[order[i]];
+        posZ[i] = data.posZ[order[i]];
+        materialIndex[i] = data.materialIndex[order[i]];
+    }
+
+    QFile file{path};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("Scene: cannot write %s", qPrintable(path));
+        return false;
+    }
+
+    bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header) &&
+              WritePadding(file, file.pos()) && WriteSection(file, data.vertices) &&
+              WritePadding(file, file.pos()) && WriteSection(file, data.indices) &&
+              WritePadding(file, file.pos()) && WriteSection(file, meshes) &&
+              WritePadding(file, file.pos()) && WriteSection(file, data.materials) &&
+              WritePadding(file, file.pos()) && WriteSection(file, posX) &&
+              WritePadding(file, file.pos()) && WriteSection(file, posY) &&
+              WritePadding(file, file.pos()) && WriteSection(file, posZ) &&
+              WritePadding(file, file.pos()) && WriteSection(file, materialIndex);
+    if (!ok)
+        qWarning("Scene: failed to write %s", qPrintable(path));
+    return ok;
+}
+
+Scene::Scene():
+    m_data{nullptr},
+    m_header{nullptr}
+{
+
+}
+
+Scene::~Scene()
+{
+    close();
+}
+
+bool Scene::load(const QString& path)
+{
+    if (!open(path))
+        return false;
+
+    if (!check())
+    {
+        qWarning("Scene: %s is corrupted", qPrintable(path));
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool Scene::open(const QString& path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        qWarning("Scene: cannot open %s", qPrintable(path));
+        return false;
+    }
+
+    uint64_t fileSize = static_cast<uint64_t>(m_file.size());
+    if (fileSize < sizeof(SceneHeader))
+    {
+        qWarning("Scene: %s is too small", qPrintable(path));
+        close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_file.size());
+    if (m_data == nullptr)
+    {
+        qWarning("Scene: cannot map %s", qPrintable(path));
+        close();
+        return false;
+    }
+
+    const SceneHeader* header = reinterpret_cast<const SceneHeader*>(m_data);
+    if (std::memcmp(header->magic, SceneMagic, sizeof(SceneMagic)) != 0 || header->version != SceneVersion)
+    {
+        qWarning("Scene: %s is not a version %u scene file", qPrintable(path), SceneVersion);
+        close();
+        return false;
+    }
+
+    bool ok = CheckSection(fileSize, header->verticesOffset, header->vertexCount, SceneVertexStride * sizeof(float)) &&
+        CheckSection(fileSize, header->indicesOffset, header->indexCount, sizeof(uint32_t)) &&
+        CheckSection(fileSize, header->meshesOffset, header->meshCount, sizeof(SceneMesh)) &&
+        CheckSection(fileSize, header->materialsOffset, header->materialCount, sizeof(Material)) &&
+        CheckSection(fileSize, header->posXOffset, header->instanceCount, sizeof(float)) &&
+        CheckSection(fileSize, header->posYOffset, header->instanceCount, sizeof(float)) &&
+        CheckSection(fileSize, header->posZOffset, header->instanceCount, sizeof(float)) &&
+        CheckSection(fileSize, header->materialIndexOffset, header->instanceCount, sizeof(uint32_t));
+
+    const SceneMesh* meshes = section<SceneMesh>(header->meshesOffset);
+    for (uint32_t i = 0; ok && i < header->meshCount; i++)
+    {
+        ok = meshes[i].firstInstance <= header->instanceCount &&
+             meshes[i].instanceCount <= header->instanceCount - meshes[i].firstInstance;
+    }
+
+    if (!ok)
+    {
+        qWarning("Scene: %s is corrupted", qPrintable(path));
+        close();
+        return false;
+    }
+
+    m_header = header;
+    return true;
+}
+
+// 索引和材质索引会整体上传到 GPU，越界会导致驱动读越界，需要逐个检查
+bool Scene::check() const
+{
+    return CheckScene(m_header->vertexCount,
+                      indices(), m_header->indexCount,
+                      meshes(), m_header->meshCount, m_header->materialCount,
+                      materialIndex(), m_header->instanceCount);
+}
+
+void Scene::close()
+{
+    if (m_data != nullptr)
+        m_file.unmap(const_cast<uchar*>(m_data));
+    if (m_file.isOpen())
+        m_file.close();
+    m_data = nullptr;
+    m_header = nullptr;
+}
+
+bool Scene::isLoaded() const
+{
+    return m_header != nullptr;
+}
+
+QSize Scene::size() const
+{
+    return QSize{static_cast<int>(m_header->width), static_cast<int>(m_header->height)};
+}
+
+const float* Scene::vertices() const
+{
+    return section<float>(m_header->verticesOffset);
+}
+
+uint32_t Scene::vertexCount() const
+{
+    return m_header->vertexCount;
+}
+
+const uint32_t* Scene::indices() const
+{
+    return section<uint32_t>(m_header->indicesOffset);
+}
+
+uint32_t Scene::indexCount() const
+{
+    return m_header->indexCount;
+}
+
+const SceneMesh* Scene::meshes() const
+{
+    return section<SceneMesh>(m_header->meshesOffset);
+}
+
+uint32_t Scene::meshCount() const
+{
+    return m_header->meshCount;
+}
+
+const Material* Scene::materials() const
+{
+    return section<Material>(m_header->materialsOffset);
+}
+
+uint32_t Scene::materialCount() const
+{
+    return m_header->materialCount;
+}
+
+const float* Scene::posX() const
+{
+    return section<float>(m_header->posXOffset);
+}
+
+const float* Scene::posY() const
+{
+    return section<float>(m_header->posYOffset);
+}
+
+const float* Scene::posZ() const
+{
+    return section<float>(m_header->posZOffset);
+}
+
+const uint32_t* Scene::materialIndex() const
+{
+    return section<uint32_t>(m_header->materialIndexOffset);
+}
+
+uint32_t Scene::instanceCount() const
+{
+    return m_header->instanceCount;
+}
@@ -0,0 +1,134 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <QFile>
+#include <QSize>
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+// 二进制场景文件格式（小端）：
+//   SceneHeader
+//   vertices      vertexCount * 6 float（位置 + 颜色）
+//   indices       indexCount uint32
+//   meshes        meshCount SceneMesh，引用 indices 中的一段和实例中的一段
+//   materials     materialCount Material，不超过 SceneMaxMaterials
+//   posX/Y/Z      instanceCount float，SoA 排列，按网格分组
+//   materialIndex instanceCount uint32
+// 每段起始位置按 16 字节对齐，偏移量记录在 header 中
+// 实例数组可以直接作为 per-instance 顶点属性上传，每个网格一次实例化绘制
+
+struct Material
+{
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float shininess;
+};
+
+struct SceneMesh
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+};
+
+struct SceneHeader
+{
+    char magic[4];              // "QNGS"
+    uint32_t version;
+    uint32_t width;             // 窗口建议尺寸
+    uint32_t height;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t meshCount;
+    uint32_t materialCount;
+    uint32_t instanceCount;
+    uint32_t reserved;
+    uint64_t verticesOffset;
+    uint64_t indicesOffset;
+    uint64_t meshesOffset;
+    uint64_t materialsOffset;
+    uint64_t posXOffset;
+    uint64_t posYOffset;
+    uint64_t posZOffset;
+    uint64_t materialIndexOffset;
+};
+
+// 材质表以 uniform 数组传给着色器，数量受限
+#define SCENE_MAX_MATERIALS 32
+
+static const uint32_t SceneVersion = 2;
+static const int SceneVertexStride = 6;
+static const uint32_t SceneMaxMaterials = SCENE_MAX_MATERIALS;
+
+// 构建场景时使用的可写数据，由文本格式解析得到，写出为二进制格式
+// meshes 的 firstInstance/instanceCount 由 WriteScene 根据 meshIndex 计算，实例按网格分组写出
+struct SceneData
+{
+    uint32_t width = 640;
+    uint32_t height = 640;
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<SceneMesh> meshes;
+    std::vector<Material> materials;
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> posZ;
+    std::vector<uint32_t> materialIndex;
+    std::vector<uint32_t> meshIndex;
+};
+
+bool ParseSceneText(const QString& path, SceneData& data);
+bool WriteScene(const QString& path, const SceneData& data);
+
+// 通过内存映射只读加载二进制场景，所有数组直接指向映射的内存，不做拷贝
+class Scene
+{
+public:
+    Scene();
+    ~Scene();
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    // load 等价于 open + check；open 只映射文件并检查 header 和各段范围，
+    // check 逐个检查索引和材质索引，耗时与场景大小成正比
+    bool load(const QString& path);
+    bool open(const QString& path);
+    bool check() const;
+    void close();
+    bool isLoaded() const;
+
+    QSize size() const;
+
+    const float* vertices() const;
+    uint32_t vertexCount() const;
+    const uint32_t* indices() const;
+    uint32_t indexCount() const;
+    const SceneMesh* meshes() const;
+    uint32_t meshCount() const;
+    const Material* materials() const;
+    uint32_t materialCount() const;
+
+    const float* posX() const;
+    const float* posY() const;
+    const float* posZ() const;
+    const uint32_t* materialIndex() const;
+    uint32_t instanceCount() const;
+
+private:
+    template<typename T>
+    const T* section(uint64_t offset) const
+    {
+        return reinterpret_cast<const T*>(m_data + offset);
+    }
+
+    QFile m_file;
+    const uchar* m_data;
+    const SceneHeader* m_header;
+};
+
+#endif // SCENE_H
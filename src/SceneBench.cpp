@@ -0,0 +1,184 @@
+#include <glad/gl.h>
+#include <QGuiApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Scene.h"
+
+// 大场景加载耗时测试
+// 用法：scene-bench [instanceCount]，默认 1000000 个实例
+// 测试文件刚刚写出，所有读取都在页缓存命中的情况下进行
+// 没有显示环境时可以设置 QT_QPA_PLATFORM=offscreen，无法创建 GL context 时跳过上传测试
+
+static void Report(const char* name, const QElapsedTimer& timer)
+{
+    std::printf("%-24s %10.3f ms\n", name, static_cast<double>(timer.nsecsElapsed()) / 1e6);
+}
+
+static bool WriteLine(QFile& file, const char* line)
+{
+    qint64 size = static_cast<qint64>(std::strlen(line));
+    return file.write(line, size) == size;
+}
+
+static bool WriteSceneText(const QString& path, uint32_t instanceCount)
+{
+    QFile file{path};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    bool ok = WriteLine(file, "size 640 640\n");
+    for (int i = 0; ok && i < 8; i++)
+    {
+        char line[64];
+        std::snprintf(line, sizeof(line), "vertex %.1f %.1f %.1f 1.0 1.0 1.0\n",
+                      (i & 1) ? 0.5 : -0.5, (i & 2) ? 0.5 : -0.5, (i & 4) ? 0.5 : -0.5);
+        ok = WriteLine(file, line);
+    }
+    ok = ok && WriteLine(file, "index 0 1 3  0 3 2  4 6 7  4 7 5  0 4 5  0 5 1\n") &&
+         WriteLine(file, "index 2 3 7  2 7 6  0 2 6  0 6 4  1 5 7  1 7 3\n") &&
+         WriteLine(file, "mesh 0 36\n") &&
+         WriteLine(file, "material 0.0215 0.1745 0.0215 0.07568 0.61424 0.07568 0.633 0.727811 0.633 0.6\n") &&
+         WriteLine(file, "material 0.25 0.25 0.25 0.4 0.4 0.4 0.774597 0.774597 0.774597 0.6\n");
+
+    std::srand(1);
+    for (uint32_t i = 0; ok && i < instanceCount; i++)
+    {
+        char line[96];
+        std::snprintf(line, sizeof(line), "instance %.3f %.3f %.3f %u 0\n",
+                      std::rand() % 200000 / 100.0 - 1000.0,
+                      std::rand() % 200000 / 100.0 - 1000.0,
+                      std::rand() % 200000 / 100.0 - 1000.0,
+                      i % 2);
+        ok = WriteLine(file, line);
+    }
+    return ok;
+}
+
+static GLADapiproc GetProcAddress(const char *name)
+{
+    QOpenGLContext* ctx = QOpenGLContext::currentContext();
+    return static_cast<GLADapiproc>(ctx->getProcAddress(name));
+}
+
+// 与 EasyGLWidget 相同的上传路径：每个数组直接从映射的内存 glBufferData
+static double UploadScene(const Scene& scene)
+{
+    GLuint buffers[6];
+    glGenBuffers(6, buffers);
+
+    QElapsedTimer timer;
+    timer.start();
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, scene.vertexCount() * SceneVertexStride * sizeof(float), scene.vertices(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, scene.indexCount() * sizeof(uint32_t), scene.indices(), GL_STATIC_DRAW);
+    const void* instanceData[4] = {scene.posX(), scene.posY(), scene.posZ(), scene.materialIndex()};
+    for (int i = 0; i < 4; i++)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[2 + i]);
+        glBufferData(GL_ARRAY_BUFFER, scene.instanceCount() * sizeof(uint32_t), instanceData[i], GL_STATIC_DRAW);
+    }
+    glFinish();
+    double elapsed = static_cast<double>(timer.nsecsElapsed()) / 1e6;
+
+    glDeleteBuffers(6, buffers);
+    return elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+    QGuiApplication app{argc, argv};
+    QStringList args = app.arguments();
+    uint32_t instanceCount = args.size() > 1 ? args[1].toUInt() : 1000000;
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+        return 1;
+    QString textPath = dir.filePath("bench.txt");
+    QString scenePath = dir.filePath("bench.scene");
+
+    if (!WriteSceneText(textPath, instanceCount))
+    {
+        std::fprintf(stderr, "cannot write %s\n", qPrintable(textPath));
+        return 1;
+    }
+    std::printf("instances: %u (warm page cache)\n", instanceCount);
+
+    QElapsedTimer timer;
+
+    // 文本格式解析，作为对照
+    SceneData data;
+    timer.start();
+    if (!ParseSceneText(textPath, data))
+        return 1;
+    Report("parse text", timer);
+
+    timer.start();
+    if (!WriteScene(scenePath, data))
+        return 1;
+    Report("write binary", timer);
+    std::printf("binary size: %lld bytes\n", static_cast<long long>(QFile{scenePath}.size()));
+
+    // 内存映射，只访问 header 和网格表
+    Scene scene;
+    timer.start();
+    if (!scene.open(scenePath))
+        return 1;
+    Report("map binary", timer);
+
+    // 逐个检查索引和材质索引
+    timer.start();
+    if (!scene.check())
+        return 1;
+    Report("check indices", timer);
+
+    // 遍历全部实例数据，在上传之前进行；posX/Y/Z 在这里首次访问，materialIndex 已由 check 访问过
+    timer.start();
+    double sum = 0.0;
+    const float* posX = scene.posX();
+    const float* posY = scene.posY();
+    const float* posZ = scene.posZ();
+    const uint32_t* materialIndex = scene.materialIndex();
+    for (uint32_t i = 0; i < scene.instanceCount(); i++)
+        sum += posX[i] + posY[i] + posZ[i] + materialIndex[i];
+    Report("touch instances", timer);
+
+    // 从映射的内存上传到 GPU，需要 GL 3.3 context
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QOpenGLContext context;
+    context.setFormat(format);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    if (context.create() && context.makeCurrent(&surface) && gladLoadGL(GetProcAddress) != 0)
+    {
+        std::printf("%-24s %10.3f ms\n", "upload to GPU", UploadScene(scene));
+        context.doneCurrent();
+    }
+    else
+    {
+        std::printf("%-24s %10s\n", "upload to GPU", "skipped");
+    }
+
+    // 读入内存拷贝，作为对照
+    timer.start();
+    QFile file{scenePath};
+    if (!file.open(QIODevice::ReadOnly))
+        return 1;
+    QByteArray bytes = file.readAll();
+    Report("read binary (copy)", timer);
+
+    std::printf("checksum: %f\n", sum + bytes.size());
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include <QCoreApplication>
+#include <QStringList>
+
+#include <cstdio>
+
+#include "Scene.h"
+
+// 将文本格式的场景转换为二进制格式
+// 用法：scene-convert <input.txt> <output.scene>
+int main(int argc, char* argv[])
+{
+    QCoreApplication app{argc, argv};
+    QStringList args = app.arguments();
+    if (args.size() != 3)
+    {
+        std::fprintf(stderr, "usage: scene-convert <input.txt> <output.scene>\n");
+        return 1;
+    }
+
+    SceneData data;
+    if (!ParseSceneText(args[1], data))
+        return 1;
+    if (!WriteScene(args[2], data))
+        return 1;
+    return 0;
+}